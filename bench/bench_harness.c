@@ -0,0 +1,601 @@
+// Project 5 - Sorting System
+// bench_harness.c
+// Runs the BENCHMARK build of main.c under simavr with scripted sensor stimulus
+// and logs every timing event as CSV for bench_report.py
+
+
+// Include libraries
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <ctype.h>
+#include "sim_avr.h"
+#include "sim_elf.h"
+#include "sim_io.h"
+#include "sim_irq.h"
+#include "avr_ioport.h"
+#include "avr_adc.h"
+
+
+// Sensor and push-button pins, must match main.c and myutils.h
+#define HALL_SENSOR_PIN 	 	1 	// PD1, active low at the homing position
+#define OR_SENSOR_PIN 	 	 	2 	// PD2, active high while an item passes
+#define EX_SENSOR_PIN 	 	 	3 	// PD3, active low while an item waits at the exit
+#define PAUSE_BUTTON_PIN 	 	4 	// PE4, active low
+#define RAMPDOWN_BUTTON_PIN 	 	5 	// PE5, active low
+
+
+// Firmware outputs
+#define DCMOTOR_FW_ROTATION 	 	0x07
+#define DCMOTOR_DISABLED 	 	0x00
+#define NUMBER_OF_COILS 	 	4
+#define DEFAULT_STEP_PER_REV 	 	200
+#define BENCH_MARKER_PORT 	 	'L'
+#define NUMBER_OF_MARKERS 	 	3
+#define ITEM_SORTED_MARKER_BIT 	 	0x04
+
+
+// Belt and tray model, all distances are in ms of belt running time
+#define OR_PULSE_BELT_MS 	 	40 	// time an item covers the OR sensor
+#define DEFAULT_TRAVEL_BELT_MS 	 	1200 	// OR sensor to EX sensor
+#define EX_CLEAR_BELT_MS 	 	30 	// time an item needs to drop off the belt end
+#define BUTTON_PRESS_MS 	 	50
+#define TRAY_HOME_OFFSET_STEPS 	 	37 	// the tray starts away from home so homing runs
+#define ADC_REFERENCE_MV 	 	5000
+#define ADC_IDLE_MV 	 	 	5000 	// belt surface with no item, reads as black
+#define MAX_ITEMS 	 	 	256
+#define MAX_ACTIVE_ISRS 	 	8
+#define STIMULUS_SEPARATORS 	 	" \t\r\n"
+#define RETI_OPCODE 	 	 	0x9518
+#define VECTOR_COUNT 	 	 	57 	// ATmega2560 interrupt vectors, reset included
+#define RUN_END_GRACE_MS 	 	100 	// keep running briefly once the belt is disabled
+#define RUN_FAILED 	 	 	2 	// exit status when the firmware halted or left items unsorted
+
+
+// define enum item state
+typedef enum
+{
+	ITEM_WAITING = 0,
+	ITEM_AT_OR,
+	ITEM_TRAVELLING,
+	ITEM_AT_EX,
+	ITEM_GONE
+}item_state_t;
+
+
+// define struct item, one entry of the stimulus script
+typedef struct
+{
+	uint32_t start_ms;
+	uint16_t reflectivity_mv;
+	uint32_t travel_belt_ms;
+	bool lost; 	 	 	// never reaches the EX sensor
+	item_state_t state;
+	double belt_ms_left;
+}bench_item_t;
+
+
+// define enum button state
+typedef enum
+{
+	BUTTON_WAITING = 0,
+	BUTTON_PRESSED,
+	BUTTON_RELEASED
+}button_state_t;
+
+
+// define struct button press from the stimulus script
+typedef struct
+{
+	uint32_t start_ms;
+	int pin;
+	button_state_t state;
+}bench_button_t;
+
+
+// Declare global variables
+static avr_t *avr = NULL;
+static FILE *event_log = NULL;
+static bench_item_t items[MAX_ITEMS];
+static int number_of_items = 0;
+static bench_button_t buttons[MAX_ITEMS];
+static int number_of_buttons = 0;
+static uint32_t end_ms = 0; 	 	// 0 runs until the belt is disabled
+static double rampdown_ms = -1.0; 	// first scripted ramp down press, -1 when there is none
+static int number_of_sorted_items = 0;
+static bool belt_is_running = false;
+static bool belt_has_started = false;
+static uint8_t portB_value = 0;
+static int tray_coil = -1;
+static int tray_position = TRAY_HOME_OFFSET_STEPS;
+static uint8_t marker_state = 0;
+static avr_irq_t *or_sensor_irq;
+static avr_irq_t *ex_sensor_irq;
+static avr_irq_t *hall_sensor_irq;
+static avr_irq_t *adc_irq;
+static avr_irq_t *portE_irq[8];
+
+
+// Declare user-defined functions
+static void log_event(const char* event, const char* name, long value);
+static void load_stimulus(const char* path);
+static uint16_t reflectivity_to_mv(const char* material);
+static void update_hall_sensor();
+static void on_portA_write(struct avr_irq_t *irq, uint32_t value, void *param);
+static void on_portB_write(struct avr_irq_t *irq, uint32_t value, void *param);
+static void on_marker_write(struct avr_irq_t *irq, uint32_t value, void *param);
+static void update_stimulus(double now_ms, double belt_step_ms);
+static int count_expected_items();
+
+
+// Start the benchmark run
+// usage: bench_harness firmware.elf stimulus.txt events.csv
+// exits with RUN_FAILED when the firmware halted or did not sort every item that reached the EX sensor
+int main(int argc, char *argv[])
+{
+	elf_firmware_t firmware;
+	memset(&firmware, 0, sizeof(firmware));
+
+	if(argc != 4)
+	{
+		fprintf(stderr, "usage: %s firmware.elf stimulus.txt events.csv\n", argv[0]);
+		return 1;
+	}
+
+	if(elf_read_firmware(argv[1], &firmware) != 0)
+	{
+		fprintf(stderr, "%s: cannot read firmware %s\n", argv[0], argv[1]);
+		return 1;
+	}
+
+	avr = avr_make_mcu_by_name(firmware.mmcu);
+	if(avr == NULL)
+	{
+		fprintf(stderr, "%s: unknown MCU '%s'\n", argv[0], firmware.mmcu);
+		return 1;
+	}
+
+	avr_init(avr);
+	avr_load_firmware(avr, &firmware);
+	avr->frequency = (firmware.frequency != 0) ? firmware.frequency : 8000000;
+	avr->avcc = ADC_REFERENCE_MV;
+	avr->aref = ADC_REFERENCE_MV;
+
+	load_stimulus(argv[2]);
+
+	event_log = fopen(argv[3], "w");
+	if(event_log == NULL)
+	{
+		fprintf(stderr, "%s: cannot write %s\n", argv[0], argv[3]);
+		return 1;
+	}
+	fprintf(event_log, "cycle,event,name,value\n");
+	log_event("meta", "frequency", (long)avr->frequency);
+	log_event("meta", "ramend", (long)avr->ramend);
+	log_event("meta", "expected_items", count_expected_items());
+
+	// watch the stepper driver, the DC motor driver and the benchmark markers
+	avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('A'), IOPORT_IRQ_REG_PORT), on_portA_write, NULL);
+	avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('B'), IOPORT_IRQ_REG_PORT), on_portB_write, NULL);
+	avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(BENCH_MARKER_PORT), IOPORT_IRQ_REG_PORT), on_marker_write, NULL);
+
+	// drive the sensor and push-button pins to their idle levels
+	or_sensor_irq = avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('D'), OR_SENSOR_PIN);
+	ex_sensor_irq = avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('D'), EX_SENSOR_PIN);
+	hall_sensor_irq = avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('D'), HALL_SENSOR_PIN);
+	adc_irq = avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, ADC_IRQ_ADC1);
+	portE_irq[PAUSE_BUTTON_PIN] = avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('E'), PAUSE_BUTTON_PIN);
+	portE_irq[RAMPDOWN_BUTTON_PIN] = avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('E'), RAMPDOWN_BUTTON_PIN);
+	avr_raise_irq(or_sensor_irq, 0);
+	avr_raise_irq(ex_sensor_irq, 1);
+	avr_raise_irq(portE_irq[PAUSE_BUTTON_PIN], 1);
+	avr_raise_irq(portE_irq[RAMPDOWN_BUTTON_PIN], 1);
+	avr_raise_irq(adc_irq, ADC_IDLE_MV);
+	update_hall_sensor();
+
+	// step one instruction at a time so ISR entry and reti can be timed exactly
+	int active_isr[MAX_ACTIVE_ISRS];
+	int active_isr_count = 0;
+	uint32_t vector_table_end = avr->vector_size * VECTOR_COUNT;
+	uint16_t min_sp = avr->ramend;
+	double last_ms = 0.0;
+	double disabled_at_ms = -1.0;
+	bool halted = false;
+	int state = cpu_Running;
+
+	while((state != cpu_Done) && (state != cpu_Crashed))
+	{
+		uint32_t pc = avr->pc;
+		uint16_t opcode = avr->flash[pc] | (avr->flash[pc + 1] << 8);
+
+		state = avr_run(avr);
+
+		// a reti closes the innermost active ISR
+		if((opcode == RETI_OPCODE) && (active_isr_count > 0))
+		{
+			active_isr_count--;
+			log_event("isr_exit", "vector", active_isr[active_isr_count]);
+		}
+
+		// landing on a vector table entry from outside it means an interrupt was taken
+		if((avr->pc != 0) && (avr->pc < vector_table_end) && ((avr->pc % avr->vector_size) == 0) &&
+			((pc >= vector_table_end) || (opcode == RETI_OPCODE)))
+		{
+			int vector = avr->pc / avr->vector_size;
+			log_event("isr_enter", "vector", vector);
+
+			if(active_isr_count < MAX_ACTIVE_ISRS)
+			{
+				active_isr[active_isr_count++] = vector;
+			}
+		}
+
+		uint16_t sp = avr->data[R_SPL] | (avr->data[R_SPH] << 8);
+		if(sp < min_sp)
+		{
+			min_sp = sp;
+		}
+
+		double now_ms = (avr->cycle * 1000.0) / avr->frequency;
+		update_stimulus(now_ms, belt_is_running ? (now_ms - last_ms) : 0.0);
+		last_ms = now_ms;
+
+		// stop at the scripted end time, or shortly after the ramp down disables the belt
+		if((end_ms != 0) && (now_ms >= end_ms))
+		{
+			break;
+		}
+
+		// the firmware also disables the belt when it halts on a fault, that is any time before
+		// the scripted ramp down was pressed
+		if(belt_has_started && (disabled_at_ms < 0.0) && (portB_value == DCMOTOR_DISABLED))
+		{
+			disabled_at_ms = now_ms;
+
+			if((rampdown_ms < 0.0) || (now_ms < rampdown_ms))
+			{
+				halted = true;
+				log_event("run", "halted", 1);
+				fprintf(stderr, "%s: firmware halted, belt disabled at %.0f ms\n", argv[0], now_ms);
+			}
+		}
+
+		if((disabled_at_ms >= 0.0) && (now_ms >= disabled_at_ms + RUN_END_GRACE_MS))
+		{
+			break;
+		}
+	}
+
+	log_event("stack", "min_sp", min_sp);
+	log_event("run", "sorted_items", number_of_sorted_items);
+	log_event("meta", "end", 0);
+	fclose(event_log);
+
+	if(state == cpu_Crashed)
+	{
+		return 1;
+	}
+
+	if(number_of_sorted_items < count_expected_items())
+	{
+		fprintf(stderr, "%s: sorted %d of %d items\n", argv[0], number_of_sorted_items, count_expected_items());
+	}
+
+	return (halted || (number_of_sorted_items < count_expected_items())) ? RUN_FAILED : 0;
+}
+
+
+// Write one event with the current cycle count
+static void log_event(const char* event, const char* name, long value)
+{
+	fprintf(event_log, "%llu,%s,%s,%ld\n", (unsigned long long)avr->cycle, event, name, value);
+}
+
+
+// Read the stimulus script, one command per line, times in ms from reset
+// <ms> item <ALUMINUM|STEEL|WHITE|BLACK> [travel_ms] [lost]
+// <ms> pause
+// <ms> rampdown
+// <ms> end
+// the tokens after the material are optional and read in order, a number sets the travel time
+static void load_stimulus(const char* path)
+{
+	FILE *script = fopen(path, "r");
+	char line[128];
+
+	if(script == NULL)
+	{
+		fprintf(stderr, "cannot read stimulus %s\n", path);
+		exit(1);
+	}
+
+	while(fgets(line, sizeof(line), script) != NULL)
+	{
+		char command[16] = "";
+		unsigned long at_ms = 0;
+
+		if((line[0] == '#') || (sscanf(line, "%lu %15s", &at_ms, command) != 2))
+		{
+			continue;
+		}
+
+		if((strcmp(command, "item") == 0) && (number_of_items < MAX_ITEMS))
+		{
+			bench_item_t *item = &items[number_of_items++];
+			char *token;
+
+			memset(item, 0, sizeof(*item));
+			item->start_ms = at_ms;
+			item->travel_belt_ms = DEFAULT_TRAVEL_BELT_MS;
+			item->state = ITEM_WAITING;
+
+			strtok(line, STIMULUS_SEPARATORS); 	// time
+			strtok(NULL, STIMULUS_SEPARATORS); 	// command
+			token = strtok(NULL, STIMULUS_SEPARATORS);
+			item->reflectivity_mv = reflectivity_to_mv((token != NULL) ? token : "");
+
+			while((token = strtok(NULL, STIMULUS_SEPARATORS)) != NULL)
+			{
+				if(isdigit((unsigned char)token[0]) && !item->lost)
+				{
+					item->travel_belt_ms = strtoul(token, NULL, 10);
+				}
+				else if(strcmp(token, "lost") == 0)
+				{
+					item->lost = true;
+				}
+				else
+				{
+					fprintf(stderr, "stimulus %s: bad item option '%s'\n", path, token);
+					exit(1);
+				}
+			}
+		}
+		else if(((strcmp(command, "pause") == 0) || (strcmp(command, "rampdown") == 0)) && (number_of_buttons < MAX_ITEMS))
+		{
+			bench_button_t *button = &buttons[number_of_buttons++];
+
+			button->start_ms = at_ms;
+			button->pin = (strcmp(command, "pause") == 0) ? PAUSE_BUTTON_PIN : RAMPDOWN_BUTTON_PIN;
+			button->state = BUTTON_WAITING;
+
+			if((button->pin == RAMPDOWN_BUTTON_PIN) && (rampdown_ms < 0.0))
+			{
+				rampdown_ms = at_ms;
+			}
+		}
+		else if(strcmp(command, "end") == 0)
+		{
+			end_ms = at_ms;
+		}
+	}
+
+	fclose(script);
+}
+
+
+// Count the scripted items that should end up in the tray, lost items never reach the EX sensor
+static int count_expected_items()
+{
+	int expected_items = 0;
+
+	for(int i = 0; i < number_of_items; i++)
+	{
+		if(!items[i].lost)
+		{
+			expected_items++;
+		}
+	}
+
+	return expected_items;
+}
+
+
+// Convert a material name into a sensor voltage inside that material's ADC band
+static uint16_t reflectivity_to_mv(const char* material)
+{
+	uint16_t adc_value;
+
+	if(strcmp(material, "ALUMINUM") == 0)
+	{
+		adc_value = 100;
+	}
+	else if(strcmp(material, "STEEL") == 0)
+	{
+		adc_value = 600;
+	}
+	else if(strcmp(material, "WHITE") == 0)
+	{
+		adc_value = 930;
+	}
+	else
+	{
+		adc_value = 990;
+	}
+
+	return (uint16_t)(((uint32_t)adc_value * ADC_REFERENCE_MV) / 1024);
+}
+
+
+// The HE sensor sees the tray's magnet only at the homing position
+static void update_hall_sensor()
+{
+	int position = ((tray_position % DEFAULT_STEP_PER_REV) + DEFAULT_STEP_PER_REV) % DEFAULT_STEP_PER_REV;
+
+	avr_raise_irq(hall_sensor_irq, (position == 0) ? 0 : 1);
+}
+
+
+// Follow the stepper coil sequence to know where the tray is
+static void on_portA_write(struct avr_irq_t *irq, uint32_t value, void *param)
+{
+	static const uint8_t coil_pattern[NUMBER_OF_COILS] = {0x36, 0x2E, 0x2D, 0x35};
+	int coil = -1;
+
+	(void)irq;
+	(void)param;
+
+	for(int i = 0; i < NUMBER_OF_COILS; i++)
+	{
+		if((value & 0x3F) == coil_pattern[i])
+		{
+			coil = i;
+		}
+	}
+
+	if(coil < 0)
+	{
+		return;
+	}
+
+	if(tray_coil >= 0)
+	{
+		int change = (coil - tray_coil + NUMBER_OF_COILS) % NUMBER_OF_COILS;
+
+		if(change == 1)
+		{
+			tray_position--; 	// clockwise steps bring the magnet towards home
+		}
+		else if(change == (NUMBER_OF_COILS - 1))
+		{
+			tray_position++;
+		}
+	}
+
+	tray_coil = coil;
+	update_hall_sensor();
+}
+
+
+// Follow the DC motor driver to know when the belt moves
+static void on_portB_write(struct avr_irq_t *irq, uint32_t value, void *param)
+{
+	(void)irq;
+	(void)param;
+
+	portB_value = value & 0x0F;
+	belt_is_running = (portB_value == DCMOTOR_FW_ROTATION);
+
+	if(belt_is_running)
+	{
+		belt_has_started = true;
+	}
+}
+
+
+// Log every change of the benchmark markers
+static void on_marker_write(struct avr_irq_t *irq, uint32_t value, void *param)
+{
+	static const char *marker_name[NUMBER_OF_MARKERS] = {"lcd_write", "stepper_step", "item_sorted"};
+
+	(void)irq;
+	(void)param;
+
+	for(int i = 0; i < NUMBER_OF_MARKERS; i++)
+	{
+		uint8_t bit = (1 << i);
+
+		if((value & bit) != (marker_state & bit))
+		{
+			log_event("marker", marker_name[i], (value & bit) ? 1 : 0);
+		}
+	}
+
+	if(((value & ITEM_SORTED_MARKER_BIT) != 0) && ((marker_state & ITEM_SORTED_MARKER_BIT) == 0))
+	{
+		number_of_sorted_items++;
+	}
+
+	marker_state = value;
+}
+
+
+// Move the items along the belt and press the buttons as the script says
+static void update_stimulus(double now_ms, double belt_step_ms)
+{
+	bool item_at_ex = false;
+
+	for(int i = 0; i < number_of_items; i++)
+	{
+		bench_item_t *item = &items[i];
+
+		switch(item->state)
+		{
+			case ITEM_WAITING:
+				if(now_ms >= item->start_ms)
+				{
+					item->state = ITEM_AT_OR;
+					item->belt_ms_left = OR_PULSE_BELT_MS;
+					avr_raise_irq(adc_irq, item->reflectivity_mv);
+					avr_raise_irq(or_sensor_irq, 1);
+					log_event("pin", "or_sensor", 1);
+				}
+				break;
+
+			case ITEM_AT_OR:
+				item->belt_ms_left -= belt_step_ms;
+				if(item->belt_ms_left <= 0.0)
+				{
+					item->state = ITEM_TRAVELLING;
+					item->belt_ms_left = item->travel_belt_ms;
+					avr_raise_irq(or_sensor_irq, 0);
+					avr_raise_irq(adc_irq, ADC_IDLE_MV);
+					log_event("pin", "or_sensor", 0);
+				}
+				break;
+
+			case ITEM_TRAVELLING:
+				if(item->lost)
+				{
+					item->state = ITEM_GONE;
+					break;
+				}
+
+				item->belt_ms_left -= belt_step_ms;
+				if((item->belt_ms_left <= 0.0) && !item_at_ex)
+				{
+					item->state = ITEM_AT_EX;
+					item->belt_ms_left = EX_CLEAR_BELT_MS;
+					avr_raise_irq(ex_sensor_irq, 0);
+					log_event("pin", "ex_sensor", 0);
+				}
+				break;
+
+			case ITEM_AT_EX:
+				// the item drops into the tray once the belt has run it off the end
+				item_at_ex = true;
+				item->belt_ms_left -= belt_step_ms;
+				if(item->belt_ms_left <= 0.0)
+				{
+					item->state = ITEM_GONE;
+					item_at_ex = false;
+					avr_raise_irq(ex_sensor_irq, 1);
+					log_event("pin", "ex_sensor", 1);
+				}
+				break;
+
+			default:
+				break;
+		}
+	}
+
+	for(int i = 0; i < number_of_buttons; i++)
+	{
+		bench_button_t *button = &buttons[i];
+
+		if((button->state == BUTTON_WAITING) && (now_ms >= button->start_ms))
+		{
+			button->state = BUTTON_PRESSED;
+			avr_raise_irq(portE_irq[button->pin], 0);
+			log_event("pin", (button->pin == PAUSE_BUTTON_PIN) ? "pause_button" : "rampdown_button", 0);
+		}
+		else if((button->state == BUTTON_PRESSED) && (now_ms >= (button->start_ms + BUTTON_PRESS_MS)))
+		{
+			button->state = BUTTON_RELEASED;
+			avr_raise_irq(portE_irq[button->pin], 1);
+			log_event("pin", (button->pin == PAUSE_BUTTON_PIN) ? "pause_button" : "rampdown_button", 1);
+		}
+	}
+}
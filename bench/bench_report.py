@@ -0,0 +1,167 @@
+#!/usr/bin/env python3
+# Project 5 - Sorting System
+# bench_report.py
+# Reduces the event log written by bench_harness into a JSON benchmark report
+#
+# usage: bench_report.py events.csv [report.json]
+
+import csv
+import json
+import sys
+
+
+# ATmega2560 interrupt vector numbers used by main.c
+VECTOR_NAMES = {
+    3: "INT2",
+    4: "INT3",
+    5: "INT4",
+    6: "INT5",
+    23: "TIMER0_OVF",
+    29: "ADC",
+    32: "TIMER3_COMPA",
+}
+
+# sensor edge that requests each external interrupt
+LATENCY_EDGES = {
+    ("or_sensor", 1): "INT2",
+    ("ex_sensor", 0): "INT3",
+}
+
+
+def summarise(samples):
+    if not samples:
+        return {"count": 0, "min": None, "max": None, "mean": None}
+    return {
+        "count": len(samples),
+        "min": min(samples),
+        "max": max(samples),
+        "mean": round(sum(samples) / len(samples), 1),
+    }
+
+
+def build_report(rows):
+    frequency = None
+    ramend = None
+    min_sp = None
+    end_cycle = 0
+    isr_start = {}
+    isr_cycles = {}
+    marker_start = {}
+    marker_cycles = {}
+    markers_active = set()
+    pending_edges = []
+    latency = {}
+    sorted_cycles = []
+    first_item_cycle = None
+    expected_items = None
+    halted = False
+
+    for row in rows:
+        cycle = int(row["cycle"])
+        event = row["event"]
+        name = row["name"]
+        value = int(row["value"])
+        end_cycle = max(end_cycle, cycle)
+
+        if event == "meta" and name == "frequency":
+            frequency = value
+        elif event == "meta" and name == "ramend":
+            ramend = value
+        elif event == "meta" and name == "expected_items":
+            expected_items = value
+        elif event == "run" and name == "halted":
+            # the firmware disabled the belt before the scripted ramp down
+            halted = halted or value != 0
+        elif event == "stack" and name == "min_sp":
+            min_sp = value
+        elif event == "isr_enter":
+            vector = VECTOR_NAMES.get(value, "VECTOR_%d" % value)
+            isr_start[vector] = cycle
+            # the first entry after a requesting edge closes that latency sample
+            for edge in [e for e in pending_edges if e["vector"] == vector]:
+                sample = latency.setdefault(vector, {"all": [], "during_lcd_write": [], "during_stepper_step": []})
+                sample["all"].append(cycle - edge["cycle"])
+                for marker in edge["markers"]:
+                    sample["during_" + marker].append(cycle - edge["cycle"])
+                pending_edges.remove(edge)
+        elif event == "isr_exit":
+            vector = VECTOR_NAMES.get(value, "VECTOR_%d" % value)
+            if vector in isr_start:
+                isr_cycles.setdefault(vector, []).append(cycle - isr_start.pop(vector))
+        elif event == "marker":
+            if name == "item_sorted":
+                if value == 1:
+                    sorted_cycles.append(cycle)
+            elif value == 1:
+                marker_start[name] = cycle
+                markers_active.add(name)
+            else:
+                markers_active.discard(name)
+                if name in marker_start:
+                    marker_cycles.setdefault(name, []).append(cycle - marker_start.pop(name))
+        elif event == "pin":
+            if name == "or_sensor" and value == 1 and first_item_cycle is None:
+                first_item_cycle = cycle
+            vector = LATENCY_EDGES.get((name, value))
+            if vector is not None:
+                pending_edges.append({"cycle": cycle, "vector": vector, "markers": sorted(markers_active)})
+
+    if frequency is None:
+        raise ValueError("event log has no frequency record")
+
+    items_per_minute = None
+    if sorted_cycles and first_item_cycle is not None and sorted_cycles[-1] > first_item_cycle:
+        elapsed_s = (sorted_cycles[-1] - first_item_cycle) / frequency
+        items_per_minute = round(len(sorted_cycles) * 60.0 / elapsed_s, 2)
+
+    return {
+        "cpu_hz": frequency,
+        "simulated_s": round(end_cycle / frequency, 3),
+        "isr_cycles": {name: summarise(samples) for name, samples in sorted(isr_cycles.items())},
+        "function_cycles": {name: summarise(samples) for name, samples in sorted(marker_cycles.items())},
+        "latency_cycles": {
+            vector: {
+                "worst": max(samples["all"]) if samples["all"] else None,
+                "worst_during_lcd_write": max(samples["during_lcd_write"]) if samples["during_lcd_write"] else None,
+                "worst_during_stepper_step": max(samples["during_stepper_step"]) if samples["during_stepper_step"] else None,
+                "samples": len(samples["all"]),
+            }
+            for vector, samples in sorted(latency.items())
+        },
+        "unserviced_edges": len(pending_edges),
+        "stack": {
+            "ramend": ramend,
+            "min_sp": min_sp,
+            "high_water_bytes": (ramend - min_sp) if (ramend is not None and min_sp is not None) else None,
+        },
+        "items": {
+            "sorted": len(sorted_cycles),
+            "items_per_minute": items_per_minute,
+        },
+        "run": {
+            "halted": halted,
+            "expected_items": expected_items,
+            "complete": (not halted) and expected_items is not None and len(sorted_cycles) >= expected_items,
+        },
+    }
+
+
+def main(argv):
+    if len(argv) not in (2, 3):
+        sys.stderr.write("usage: %s events.csv [report.json]\n" % argv[0])
+        return 1
+
+    with open(argv[1], newline="") as events:
+        report = build_report(csv.DictReader(events))
+
+    text = json.dumps(report, indent=2) + "\n"
+    if len(argv) == 3:
+        with open(argv[2], "w") as output:
+            output.write(text)
+    else:
+        sys.stdout.write(text)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -13,6 +13,9 @@
 #include "lcd.h" 
 #include "LinkedQueue.h" 
 #include "myutils.h" 
+#ifdef BENCHMARK
+#include "avr_mcu_section.h" 
+#endif
  
 
 #define RAMP_STEP (MINIMUM_SPEED - MAXIMUM_SPEED) 
@@ -24,6 +27,24 @@
 #define EX_SENSOR_BIT 	 	 	0x08
  
  
+// Benchmark instrumentation - build with -DBENCHMARK and run with the harness in bench/ 
+// each marker bit on PORTL is high while the traced code is running, PORTL is free on the 
+// ATmega2560 so the markers do not disturb the LEDs, ISR timing is taken by the harness 
+// from the vector fetch to the reti, so the ISRs carry no markers 
+#ifdef BENCHMARK 
+#define BENCH_PORT 	 	 	PORTL 
+#define BENCH_DDR 	 	 	DDRL 
+#define BENCH_LCD_WRITE_BIT 	 	0x01 
+#define BENCH_STEPPER_STEP_BIT 	 	0x02 
+#define BENCH_ITEM_SORTED_BIT 	 	0x04 
+#define BENCH_MARK_BEGIN(bit) 	 	(BENCH_PORT |= (bit)) 
+#define BENCH_MARK_END(bit) 	 	(BENCH_PORT &= ~(bit)) 
+#else 
+#define BENCH_MARK_BEGIN(bit) 
+#define BENCH_MARK_END(bit) 
+#endif
+ 
+ 
 // Reflective sensor - Threshold Values 	
 #define BLACK_MAX  	 	 	1023 
 #define BLACK_MIN  	 	 	956 
@@ -55,6 +76,36 @@
 #define STEP_POSITION_STEEL  		150 
 #define DEFAULT_STEP_PER_REV 		200 
 #define HALF_WAY 	 	 	100 
+#define HOMING_STEP_LIMIT 	 	(DEFAULT_STEP_PER_REV + RAMP_STEP) 
+#define HOMING_RETRIES 	 	 	3 
+#define TRAY_MOVE_RETRIES 	 	2 	// re-home and turn again this many times after a stall 
+ 
+ 
+// Jam supervision - system tick is the Timer 0 overflow of the DC motor PWM 
+// 256 counts at 8MHz / 64 = 2048us, ticks only advance while the belt is running 
+#define SYSTEM_TICK_US 	 	 	2048 
+#define MS_TO_SYSTEM_TICKS(ms) 	 	(((uint32_t)(ms) * 1000UL) / SYSTEM_TICK_US) 
+// the OR to EX travel time is measured from every sorted item, the seed is only a deliberately 
+// long guess that covers the first items before a measurement exists 
+#define OR_TO_EX_TRAVEL_SEED_MS 	1500 
+// an item is expected at EX between these fractions of the travel time after it passed OR 
+// until the first measurement the window is open from the OR sensor to twice the seed 
+#define ITEM_ARRIVAL_WINDOW_MIN_PERCENT 75 
+#define ITEM_ARRIVAL_WINDOW_MAX_PERCENT 125 
+#define ITEM_SEED_WINDOW_MAX_PERCENT 	200 
+#define TRAVEL_AVERAGE_WEIGHT 	 	4 	// each new measurement moves the average by 1/4 
+#define MAX_TRACKED_ITEMS 	 	16 	// more items than the belt can physically hold, power of 2 
+ 
+ 
+// Throughput meter - a ring of 15s buckets gives the rates over the last 5 minutes 
+#define NUMBER_OF_MATERIALS 	 	4 
+#define MS_PER_MINUTE 	 	 	60000UL 
+#define THROUGHPUT_BUCKET_MS 	 	15000 
+#define THROUGHPUT_WINDOW_BUCKETS 	20 
+#define THROUGHPUT_BUCKET_TICKS 	MS_TO_SYSTEM_TICKS(THROUGHPUT_BUCKET_MS) 
+#define THROUGHPUT_WINDOW_TICKS 	(THROUGHPUT_BUCKET_TICKS * THROUGHPUT_WINDOW_BUCKETS) 
+#define STATISTICS_PAGE_DISPLAY_MS 	2000 
+#define STATISTICS_PAGE_POLL_MS 	10 
 
  
 // define enum item type 
@@ -77,6 +128,36 @@ typedef enum
 }DCmotor_state_t; 
  
  
+// define enum statistics page, shown in this order on the LCD 
+typedef enum 
+{ 
+ 	PAGE_SORTED_SUMMARY = 0, 
+ 	PAGE_TOTALS_AL_WH, 
+ 	PAGE_TOTALS_ST_BL, 
+ 	PAGE_THROUGHPUT, 
+ 	PAGE_MATERIAL_RATE, 
+ 	PAGE_FAULTS, 
+ 	NUMBER_OF_STATISTICS_PAGES 
+}statistics_page_t; 
+ 
+ 
+// define struct throughput bucket, one interval of the rolling window 
+typedef struct 
+{ 
+ 	uint16_t items[NUMBER_OF_MATERIALS]; 
+ 	uint16_t belt_running_ticks; 
+}throughput_bucket_t; 
+ 
+ 
+// define enum item arrival, where the belt time stands against the arrival window of a tracked item 
+typedef enum 
+{ 
+ 	ITEM_ARRIVAL_TOO_EARLY = 0, 
+ 	ITEM_ARRIVAL_IN_WINDOW, 
+ 	ITEM_ARRIVAL_OVERDUE 
+}item_arrival_t; 
+ 
+ 
 // define enum direction 
 typedef enum  
 { 
@@ -100,32 +181,77 @@ volatile bool ramp_down_flag = false;
 volatile bool timer_is_running_flag = false; 
 volatile bool object_at_exit_flag = false; 
 volatile bool object_type_detected_flag = false; 
+volatile bool tray_passed_home_flag = false; 
 volatile uint16_t steppermotor_current_position  = 0; 
 volatile int16_t  steppermotor_current_coil = 0; 
 volatile uint16_t steppermotor_home_position = 0; 
 volatile uint16_t step = 0; 
-volatile uint16_t number_of_black_items	= 0; 
-volatile uint16_t number_of_aluminum_items = 0; 
-volatile uint16_t number_of_white_items	= 0; 
-volatile uint16_t number_of_steel_items	= 0; 
+volatile uint32_t number_of_black_items	= 0; 
+volatile uint32_t number_of_aluminum_items = 0; 
+volatile uint32_t number_of_white_items	= 0; 
+volatile uint32_t number_of_steel_items	= 0; 
+volatile uint16_t number_of_missing_items = 0; 
+volatile uint16_t number_of_unexpected_items = 0; 
+volatile uint16_t number_of_tray_stalls = 0; 
+volatile uint16_t number_of_homing_failures = 0; 
+volatile bool belt_is_running_flag = false; 
+volatile uint32_t belt_running_ticks = 0; 
+volatile uint32_t system_ticks = 0; 
+uint16_t DCmotor_current_speed = DCMOTOR_FIXED_SPEED; 
+uint32_t item_enqueue_tick[MAX_TRACKED_ITEMS]; 
+uint16_t or_to_ex_travel_ms = OR_TO_EX_TRAVEL_SEED_MS; // at DCMOTOR_FIXED_SPEED 
+bool or_to_ex_travel_measured = false; 
+uint8_t item_deadline_head = 0; 
+uint8_t item_deadline_count = 0; 
+throughput_bucket_t throughput_buckets[THROUGHPUT_WINDOW_BUCKETS]; 
+uint8_t throughput_current_bucket = 0; 
+uint8_t throughput_completed_buckets = 0; 
+uint32_t throughput_bucket_start_tick = 0; 
+uint32_t throughput_bucket_start_belt_tick = 0; 
+uint16_t window_items[NUMBER_OF_MATERIALS]; // running sums over the whole window 
+uint32_t window_belt_running_ticks = 0; 	// running sum over the completed buckets 
 volatile uint16_t material_type = 0; 
 volatile uint16_t lowest_ADC_result	= 0; 
 volatile uint16_t new_ADC_result = 0; 
  
  
-// Declare user-defined functions void initialize_PWM(); void initialize_ADC(); 
+// Declare user-defined functions 
+void initialize_PWM(); 
+void initialize_ADC(); 
 void initialize_external_interrupts(); 
-void initialize_steppermotor_homing_position(); 
+void initialize_system_tick(); 
+bool initialize_steppermotor_homing_position(); 
+void home_tray(); 
+void move_tray_to_bin(item_type_t item_type); 
+void halt_system(const char* line_1_string, const char* line_2_string); 
+bool verify_tray_position(); 
 void control_steppermotor_step(uint16_t total_steps, steppermotor_direction_t rotational_direction); 
-void rotate_tray(item_type_t item_type); 
+bool rotate_tray(item_type_t item_type); 
 void control_DCmotor_speed(uint16_t DCmotor_speed); 
 void control_DCmotor_state(DCmotor_state_t DCmotor_state); 
 item_type_t determine_material_type(uint16_t reflectivity); 
 uint16_t convert_material_to_step(item_type_t material); 
 void count_sorted_item(item_type_t material); 
 void display_sorted_item(link **head, link **tail); 
+void display_statistics_page(statistics_page_t page, link **head, link **tail); 
+void browse_statistics_pages(link **head, link **tail, bool until_resumed); 
+void update_throughput_window(); 
+void record_item_in_throughput_window(item_type_t material); 
+uint32_t get_window_elapsed_ticks(); 
+uint16_t get_items_per_minute(uint16_t items); 
+uint16_t get_total_items_per_minute(); 
+uint16_t get_belt_utilisation_percent(); 
 const char* get_item_name(item_type_t item_type); 
 void write_lines_to_LCD(const char* line_1_string, const char* line_2_string); 
+void write_a_uint32_value_To_LCD_xy_position(uint8_t x, uint8_t y, uint32_t value, uint8_t digits); 
+uint32_t read_tick_counter(volatile uint32_t *tick_counter); 
+void track_item_arrival_deadline(); 
+void release_item_arrival_deadline(); 
+item_arrival_t get_item_arrival(uint8_t queue_position); 
+bool item_arrival_deadline_passed(); 
+void drop_missing_item(link **h, link **t); 
+void record_item_travel_time(); 
+uint32_t get_item_travel_ticks(); 
 
 
 // Declare user-defined functions 
@@ -139,7 +265,8 @@ int main(void)
     	CLKPR = 0x80; // set CLKPCE = clock pre-scaler change enable to 1 
     	CLKPR = 0x01; // set the main clock to /2 = 8MHz 
  	 
- 	link *head; // Sets up head of queue  	link *tail; // Sets up tail of queue 
+ 	link *head; // Sets up head of queue 
+ 	link *tail; // Sets up tail of queue 
  	link *deQueuedLink; // Creating one pointer handle to be reused multiple times 
  	 
  	setup(&head, &tail); // Set up link list 
@@ -152,18 +279,28 @@ int main(void)
     	DDRD = 0x00; // external interrupt 
  	DDRE = 0x00; // external interrupt 
     	DDRF = 0x00; // ADC control 
+#ifdef BENCHMARK 
+ 	BENCH_DDR = 0xFF; // benchmark markers 
+#endif 
       
- 	initialize_LCD(LS_BLINK | LS_ULINE); // set parameters to operate the LCD  	initialize_PWM(); // set PWM parameters to control DC motor speed  	initialize_ADC(); // set ADC parameters to begin conversion 
+ 	initialize_LCD(LS_BLINK | LS_ULINE); // set parameters to operate the LCD 
+ 	initialize_PWM(); // set PWM parameters to control DC motor speed 
+ 	initialize_ADC(); // set ADC parameters to begin conversion 
     	initialize_external_interrupts(); // set external interrupt pins 	 
+ 	initialize_system_tick(); // set the belt running time base for jam supervision 
  	 	     
     	sei(); // enable global interrupt 
  	 
- 	initialize_steppermotor_homing_position(); // set stepper motor to locate the home position 
+ 	home_tray(); // set stepper motor to locate the home position 
  	 
- 	control_DCmotor_state(START); // turn on the DC motor  	control_DCmotor_speed(DCMOTOR_FIXED_SPEED); // set DC motor's speed 
+ 	control_DCmotor_state(START); // turn on the DC motor 
+ 	control_DCmotor_speed(DCMOTOR_FIXED_SPEED); // set DC motor's speed 
  	 	 
     	while(1)  
  	{ 
+ 	 	// Keep the throughput window's buckets rolling on time 
+ 	 	update_throughput_window(); 
+ 	 	 
  	 	// Check if the object has passed the OR sensor and PIND2 is Active High  
  	 	// and if it has been classified    	 	
 		// If it has, then: 
@@ -175,9 +312,12 @@ int main(void)
 			link *new_link;
 			initLink(&new_link); 
 			new_link->e.item_type = (char)item_type;
+			track_item_arrival_deadline();
 			enqueue(&head, &tail, &new_link);
 			object_type_detected_flag = false;
   	 	 	write_lines_to_LCD("Item type", get_item_name(item_type)); 
+ 	 	 	write_a_uint32_value_To_LCD_xy_position(10, 0, get_total_items_per_minute(), 3); 
+ 	 	 	write_a_string_To_LCD_xy_position(13, 0, "/m"); 
  	 	} 
  	 	 
  	 	// Check if the EX sensor has detected an object at the exit and PIND3 is Active Low 
@@ -188,21 +328,58 @@ int main(void)
  	 	// - Count the number of items for each type 
  	 	// - Clear the exit sensor flag 
  	 	// - Start the conveyor belt again to drop the object to the correct bin  
+ 	 	// - If the tray has stalled, re-home it and turn it again 
+ 	 	// - If the item at the head of the link list is overdue while the next one is inside its arrival 
+ 	 	//   window, the head item was lost on the belt, drop it as missing and sort against the next one 
+ 	 	// - If the link list is empty, or the item at its head cannot have reached the EX sensor yet, 
+ 	 	//   this is a late item whose entry was already dropped as missing, let it pass unsorted 
+ 	 	//   and keep the link list in step with the belt 
  	 	// if(object_at_exit_flag == true) 
+ 	 	if((object_at_exit_flag == true) && ((PIND & EX_SENSOR_BIT) == 0x00)) 
+ 	 	{ 
+ 	 	 	while((item_deadline_count > 1) && (get_item_arrival(0) == ITEM_ARRIVAL_OVERDUE) && 
+ 	 	 	 	(get_item_arrival(1) == ITEM_ARRIVAL_IN_WINDOW)) 
+ 	 	 	{ 
+ 	 	 	 	drop_missing_item(&head, &tail); 
+ 	 	 	} 
+ 	 	} 
+ 	 	 
+ 	 	if((object_at_exit_flag == true) && ((PIND & EX_SENSOR_BIT) == 0x00) && 
+ 	 	 	((isEmpty(&head) == 1) || (get_item_arrival(0) == ITEM_ARRIVAL_TOO_EARLY))) 
+ 	 	{ 
+ 	 	 	number_of_unexpected_items++; 
+ 	 	 	object_at_exit_flag = false; 
+ 	 	} 
+ 	 	 
  	 	if((object_at_exit_flag == true) && ((PIND & EX_SENSOR_BIT) == 0x00)) 
  	 	{ 
  	 	 	control_DCmotor_state(STOP);
   	 	 	item_type_t item_type;
   	 	 	dequeue(&head, &tail, &deQueuedLink); 
+ 	 	 	record_item_travel_time(); 
+ 	 	 	release_item_arrival_deadline(); 
  	 	 	item_type = deQueuedLink->e.item_type;
   	 	 	free(deQueuedLink); 
  	 	 	write_lines_to_LCD("Rotating tray", NULL);
   	 	 	write_an_int_value_To_LCD_xy_position(0, 1, item_type, 3);
-  	 	 	rotate_tray(item_type);
+  	 	 	move_tray_to_bin(item_type); 
   	 	 	count_sorted_item(item_type); 
+ 	 	 	BENCH_MARK_BEGIN(BENCH_ITEM_SORTED_BIT); // pulse once per sorted item 
+ 	 	 	BENCH_MARK_END(BENCH_ITEM_SORTED_BIT); 
  	 	 	object_at_exit_flag = false; 
  	 	 	control_DCmotor_state(START); 	 	 	 
  	 	} 
+ 	 	 
+ 	 	// Check if the item at the head of the link list has missed its arrival deadline at the EX sensor 
+ 	 	// If it has, then: 
+ 	 	// - Take the stale item off the link list and free the memory 
+ 	 	// - Count the missing item 
+ 	 	// - Keep the conveyor belt running for the items behind it 
+ 	 	if((object_at_exit_flag == false) && (isEmpty(&head) == 0) && (item_arrival_deadline_passed() == true)) 
+ 	 	{ 
+ 	 	 	drop_missing_item(&head, &tail); 
+ 	 	 	write_lines_to_LCD("Item missing", "Entry dropped"); 
+ 	 	} 
  	 	 	 	 
  	 	// Check if the ramp down button has been pressed and PINE 5 is Active Low  
  	 	// If it has, then: 
@@ -210,8 +387,8 @@ int main(void)
  	 	// - Delay for about 500ms to clear all objects still on system 
  	 	// - Stop the conveyor belt 
  	 	// - Disable global interrupt 
- 	 	// - Display the number of items for each type 
  	 	// - Clear the ramp down flag 
+ 	 	// - Browse the statistics pages until reset 
  	 	if(ramp_down_flag == true) 
  	 	{ 
  	 	 	if(isEmpty(&head) == 1)  
@@ -221,12 +398,12 @@ int main(void)
   	 	 	 	control_DCmotor_state(STOP);
   	 	 	 	ms_timer(10); 
  	 	 	 	control_DCmotor_state(DISABLE);
-  	 	 	 	display_sorted_item(&head, &tail); 
  	 	 	 	ramp_down_flag = false; 
  	 	 	 	 
  	 	 	 	while(1) 
  	 	 	 	{ 
  	 	 	 	 	// system has been disabled, stay here until reset 
+ 	 	 	 	 	browse_statistics_pages(&head, &tail, false); 
  	 	 	 	} 
  	 	 	} 
  	 	} 
@@ -234,8 +411,7 @@ int main(void)
 		// Check if the pause button has been pressed and PINE 4 is Active Low   	
 		// If it has, then: 
 	 	// - Stop the conveyor belt 
-	 	// - Display the number of items for each type 
-	 	// - Wait for flag change 
+	 	// - Browse the statistics pages until the flag changes 
 		// - Start the conveyor belt again to resume normal system operation  	
 		if(pause_flag == true) 
  	 	{ 
@@ -243,12 +419,7 @@ int main(void)
  	 	 	// ms_timer(10); 
  	 	 	write_lines_to_LCD("System Paused", NULL); 
  	 	 	ms_timer(20); 
- 	 	 	display_sorted_item(&head, &tail); 
- 	 	 	 
- 	 	 	while(pause_flag != false)  
- 	 	 	{ 
- 	 	 	 	// wait here until the button is pressed then exit while loop 
- 	 	 	} 
+ 	 	 	browse_statistics_pages(&head, &tail, true); // wait here until the button is pressed 
  	 	 	 
  	 	 	write_lines_to_LCD("System Resumed", NULL); 
  	 	 	control_DCmotor_state(START); 
@@ -264,7 +435,8 @@ void initialize_PWM()
 							// Timer/Counter Mode: Fast PWM 
 							// Maximum (TOP) counter: 0xFF 
  	TCCR0A |= (1 << COM0A1); // clears OC0A on Compare Output, Fast PWM Mode 
- 	TCCR0B |= ((1 << CS01) | (1 << CS00)); // sets clock source to 1/64 } 
+ 	TCCR0B |= ((1 << CS01) | (1 << CS00)); // sets clock source to 1/64 
+} 
  
  
 // Initialize the ADC parameters to read the material’s reflectivity 
@@ -301,20 +473,102 @@ void initialize_external_interrupts()
 } 
  
  
+// Initialize the system tick on the Timer 0 overflow, Timer 0 keeps running the DC motor PWM 
+void initialize_system_tick() 
+{ 
+ 	TIMSK0 |= (1 << TOIE0); // enable the Timer 0 overflow interrupt 
+} 
+ 
+ 
 // Initialize and setup stepper motor to find and return to the homing position 
-void initialize_steppermotor_homing_position()  
+// give up after a full revolution without detection so a stalled tray cannot hang the system 
+bool initialize_steppermotor_homing_position()  
 { 
+ 	uint16_t steps_taken = 0; 
+ 	 
  	write_lines_to_LCD("Searching for", "homing position"); 
  	 
  	// check if the HE sensor has detected the metallic part's magnetic field  	
 	// if it has not, continue to rotate stepper motor until the detection occurs  	
 	while((PIND & HALL_SENSOR_BIT) == HALL_SENSOR_BIT) 
  	{ 
+ 	 	if(steps_taken >= HOMING_STEP_LIMIT) 
+ 	 	{ 
+ 	 	 	write_lines_to_LCD("Homing failed", NULL); 
+ 	 	 	return false; 
+ 	 	} 
+ 	 	 
  	 	control_steppermotor_step(1, CLOCKWISE_ROTATION); 
+ 	 	steps_taken++; 
  	} 	 
  	 
 	steppermotor_current_position = 0;
     	write_lines_to_LCD("Found", "homing position"); 
+ 	return true; 
+} 
+ 
+ 
+// Return the tray to the homing position, retrying a few times before halting the system 
+void home_tray() 
+{ 
+ 	for(uint8_t attempt = 0; attempt < HOMING_RETRIES; attempt++) 
+ 	{ 
+ 	 	if(initialize_steppermotor_homing_position() == true) 
+ 	 	{ 
+ 	 	 	return; 
+ 	 	} 
+ 	 	 
+ 	 	number_of_homing_failures++; 
+ 	} 
+ 	 
+ 	halt_system("ERROR: tray lost", "Reset required"); // the HE sensor never detected the tray 
+} 
+ 
+ 
+// Turn the tray to the item's bin, re-homing and turning again after each stall 
+// halt the system once the retries run out so no item is dropped into the wrong bin 
+void move_tray_to_bin(item_type_t item_type) 
+{ 
+ 	uint8_t attempt = 0; 
+ 	 
+ 	while(rotate_tray(item_type) == false) 
+ 	{ 
+ 	 	number_of_tray_stalls++; 
+ 	 	 
+ 	 	if(attempt >= TRAY_MOVE_RETRIES) 
+ 	 	{ 
+ 	 	 	halt_system("ERROR: tray stall", "Reset required"); 
+ 	 	} 
+ 	 	 
+ 	 	attempt++; 
+ 	 	write_lines_to_LCD("Tray stalled", "Re-homing"); 
+ 	 	home_tray(); 
+ 	} 
+} 
+ 
+ 
+// Stop the conveyor belt and show the error, then stay here until reset 
+void halt_system(const char* line_1_string, const char* line_2_string) 
+{ 
+ 	control_DCmotor_state(DISABLE); 
+ 	write_lines_to_LCD(line_1_string, line_2_string); 
+ 	 
+ 	while(1) 
+ 	{ 
+ 	 	// the system cannot recover on its own, stay here until reset 
+ 	} 
+} 
+ 
+ 
+// Check the HE sensor against the tray position after a move 
+// the sensor must be active at the homing position and inactive everywhere else 
+// the sensor stays inactive over a move between two bins that does not pass the homing position 
+// (50 <-> 100 and 100 <-> 150), a stall during such a move is not detected 
+bool verify_tray_position() 
+{ 
+ 	bool tray_is_at_home = ((PIND & HALL_SENSOR_BIT) == 0x00); 
+ 	 
+ 	return (tray_is_at_home == (steppermotor_current_position == STEP_POSITION_BLACK)); 
 } 
  
  
@@ -328,6 +582,8 @@ void control_steppermotor_step(uint16_t total_steps, steppermotor_direction_t ro
  	PORTA = steppermotor_rotation_LUT[steppermotor_current_coil];  	
 	uint16_t step_delay_ms = MINIMUM_SPEED; 
  	 
+ 	BENCH_MARK_BEGIN(BENCH_STEPPER_STEP_BIT); 
+ 	 
  	while(steps_left > 0)  
  	{ 
  	 	// decide the stepper motor's rotational direction  	 	
@@ -353,6 +609,12 @@ void control_steppermotor_step(uint16_t total_steps, steppermotor_direction_t ro
  	 	// execute the stepping for each coil following the LUT  	
 		PORTA = steppermotor_rotation_LUT[steppermotor_current_coil];  	
 		ms_timer(step_delay_ms); 
+ 	 	 
+ 	 	// note when the HE sensor sees the tray pass the homing position 
+ 	 	if((PIND & HALL_SENSOR_BIT) == 0x00) 
+ 	 	{ 
+ 	 	 	tray_passed_home_flag = true; 
+ 	 	} 
  	 
 	 	// Implement trapezoidal velocity profile 
 	 	// solve by comparing the default 15 ramp down/up steps 
@@ -370,13 +632,18 @@ void control_steppermotor_step(uint16_t total_steps, steppermotor_direction_t ro
  	 	 
  	 	steps_left--; 
  	} 
+ 	 
+ 	BENCH_MARK_END(BENCH_STEPPER_STEP_BIT); 
 } 
  
  
 // Command the tray to rotate once the item type has been identified and converted to number of steps 
-void rotate_tray(item_type_t item_type)  
+// return false if the HE sensor shows that the tray did not reach the new position, or that it did 
+// not pass the homing position on the way 
+bool rotate_tray(item_type_t item_type)  
 { 
  	int16_t step_to_take; 
+ 	bool move_passes_home = false; 
  	steppermotor_direction_t direction = CLOCKWISE_ROTATION; 
  	uint16_t steppermotor_new_position = convert_material_to_step(item_type); 
  	 
@@ -417,15 +684,42 @@ void rotate_tray(item_type_t item_type)
 	 	 	direction = CLOCKWISE_ROTATION; 
 	 	} 
 	}  
+ 	 
+ 	// a half turn between two bins is as short either way, take the way through the homing 
+ 	// position so the HE sensor can confirm that the tray moved (50 <-> 150) 
+ 	if((step_to_take == HALF_WAY) && (steppermotor_current_position != STEP_POSITION_BLACK) && 
+ 	 	(steppermotor_new_position != STEP_POSITION_BLACK)) 
+ 	{ 
+ 	 	if(direction == CLOCKWISE_ROTATION) 
+ 	 	{ 
+ 	 	 	direction = COUNTER_CLOCKWISE_ROTATION; 
+ 	 	} 
+ 	 	else 
+ 	 	{ 
+ 	 	 	direction = CLOCKWISE_ROTATION; 
+ 	 	} 
+ 	 	 
+ 	 	move_passes_home = true; 
+ 	} 
+ 	 
+ 	tray_passed_home_flag = false; 
 	write_lines_to_LCD(NULL, NULL); 
 	write_an_int_value_To_LCD_xy_position(0, 0, steppermotor_new_position, 5); write_an_int_value_To_LCD_xy_position(0, 1, step_to_take, 5);  control_steppermotor_step(step_to_take, direction); 
  	steppermotor_current_position = steppermotor_new_position; 
+ 	 
+ 	if((move_passes_home == true) && (tray_passed_home_flag == false)) 
+ 	{ 
+ 	 	return false; 
+ 	} 
+ 	 
+ 	return verify_tray_position(); 
 } 
  
 // Control the speed of DC motor 
 void control_DCmotor_speed(uint16_t DCmotor_speed)  
 { 
  	OCR0A = DCmotor_speed; 
+ 	DCmotor_current_speed = DCmotor_speed; 
 } 
  
  
@@ -436,14 +730,17 @@ void control_DCmotor_state(DCmotor_state_t DCmotor_state)
  	{ 
  	 	case START: 
  	 		PORTB = DCMOTOR_FW_ROTATION; 
+ 	 		belt_is_running_flag = true; 
  	 		break;
 		
 		case STOP: 
  	 		PORTB = DCMOTOR_BRAKE_HIGH; // brake DC motor by setting all bits to 1s  
+ 	 		belt_is_running_flag = false; 
  	 		break;
 		
 		case DISABLE: 
  	 		PORTB = DCMOTOR_DISABLED; // disable DC motor by setting bits ENA and ENB to 0 
+ 	 		belt_is_running_flag = false; 
  	 	 	break;
 		
 		default: 
@@ -535,10 +832,13 @@ void count_sorted_item(item_type_t material)
 		default: 
  	 	 	break; 
  	} 
+ 	 
+ 	record_item_in_throughput_window(material); 
 } 
  
  
-// Display the item's name on the LCD when it passes the sensor const char* get_item_name(item_type_t item_type) 
+// Display the item's name on the LCD when it passes the sensor 
+const char* get_item_name(item_type_t item_type) 
 { 
  	switch(item_type) 
  	{ 
@@ -566,22 +866,220 @@ void count_sorted_item(item_type_t material)
  
  
 // Display the number of sorted item for each type of four materials on the LCD screen 
+// the 2-digit fields stop at 99, the totals pages show the full counts 
 void display_sorted_item(link **head, link **tail)  
 { 	 
  	write_lines_to_LCD("AL WH ST BL #OB", NULL); 
- 	write_an_int_value_To_LCD_xy_position(0, 1, number_of_aluminum_items, 2); 
- 	write_an_int_value_To_LCD_xy_position(3, 1, number_of_white_items, 2); 
- 	write_an_int_value_To_LCD_xy_position(6, 1, number_of_steel_items, 2); 
- 	write_an_int_value_To_LCD_xy_position(9, 1, number_of_black_items, 2); 
+ 	write_a_uint32_value_To_LCD_xy_position(0, 1, number_of_aluminum_items, 2); 
+ 	write_a_uint32_value_To_LCD_xy_position(3, 1, number_of_white_items, 2); 
+ 	write_a_uint32_value_To_LCD_xy_position(6, 1, number_of_steel_items, 2); 
+ 	write_a_uint32_value_To_LCD_xy_position(9, 1, number_of_black_items, 2); 
   	write_an_int_value_To_LCD_xy_position(13, 1, size(head, tail), 2); 
 }
  
  
-// This function is reused in several places to display two strings on two lines void 
-write_lines_to_LCD(const char* line_1_string, const char* line_2_string) 
+// Display one page of the sorting statistics on the LCD screen 
+void display_statistics_page(statistics_page_t page, link **head, link **tail) 
+{ 
+ 	update_throughput_window(); 
+ 	 
+ 	switch(page) 
+ 	{ 
+ 	 	case PAGE_SORTED_SUMMARY: 
+ 	 	 	display_sorted_item(head, tail); 
+ 	 	 	break; 
+ 	 	 
+ 	 	case PAGE_TOTALS_AL_WH: 
+ 	 	 	write_lines_to_LCD("AL", "WH"); 
+ 	 	 	write_a_uint32_value_To_LCD_xy_position(6, 0, number_of_aluminum_items, 10); 
+ 	 	 	write_a_uint32_value_To_LCD_xy_position(6, 1, number_of_white_items, 10); 
+ 	 	 	break; 
+ 	 	 
+ 	 	case PAGE_TOTALS_ST_BL: 
+ 	 	 	write_lines_to_LCD("ST", "BL"); 
+ 	 	 	write_a_uint32_value_To_LCD_xy_position(6, 0, number_of_steel_items, 10); 
+ 	 	 	write_a_uint32_value_To_LCD_xy_position(6, 1, number_of_black_items, 10); 
+ 	 	 	break; 
+ 	 	 
+ 	 	case PAGE_THROUGHPUT: 
+ 	 	 	write_lines_to_LCD("Items/min", "Belt use %"); 
+ 	 	 	write_a_uint32_value_To_LCD_xy_position(12, 0, get_total_items_per_minute(), 4); 
+ 	 	 	write_a_uint32_value_To_LCD_xy_position(12, 1, get_belt_utilisation_percent(), 4); 
+ 	 	 	break; 
+ 	 	 
+ 	 	case PAGE_MATERIAL_RATE: 
+ 	 	 	write_lines_to_LCD("AL  WH  ST  BL/m", NULL); 
+ 	 	 	write_a_uint32_value_To_LCD_xy_position(0, 1, get_items_per_minute(window_items[ALUMINUM_ITEM]), 3); 
+ 	 	 	write_a_uint32_value_To_LCD_xy_position(4, 1, get_items_per_minute(window_items[WHITE_ITEM]), 3); 
+ 	 	 	write_a_uint32_value_To_LCD_xy_position(8, 1, get_items_per_minute(window_items[STEEL_ITEM]), 3); 
+ 	 	 	write_a_uint32_value_To_LCD_xy_position(12, 1, get_items_per_minute(window_items[BLACK_ITEM]), 3); 
+ 	 	 	break; 
+ 	 	 
+ 	 	case PAGE_FAULTS: 
+ 	 	 	write_lines_to_LCD("MIS UNX STL HOM", NULL); 
+ 	 	 	write_a_uint32_value_To_LCD_xy_position(0, 1, number_of_missing_items, 3); 
+ 	 	 	write_a_uint32_value_To_LCD_xy_position(4, 1, number_of_unexpected_items, 3); 
+ 	 	 	write_a_uint32_value_To_LCD_xy_position(8, 1, number_of_tray_stalls, 3); 
+ 	 	 	write_a_uint32_value_To_LCD_xy_position(12, 1, number_of_homing_failures, 3); 
+ 	 	 	break; 
+ 	 	 
+ 	 	default: 
+ 	 	 	break; 
+ 	} 
+} 
+ 
+ 
+// Cycle through the statistics pages on the LCD screen, one page every 2 seconds 
+// keep going until the pause flag is cleared, or forever when until_resumed is false 
+void browse_statistics_pages(link **head, link **tail, bool until_resumed) 
+{ 
+ 	statistics_page_t page = PAGE_SORTED_SUMMARY; 
+ 	uint16_t page_shown_ms = 0; 
+ 	 
+ 	display_statistics_page(page, head, tail); 
+ 	 
+ 	while((until_resumed == false) || (pause_flag != false)) 
+ 	{ 
+ 	 	ms_timer(STATISTICS_PAGE_POLL_MS); 
+ 	 	page_shown_ms += STATISTICS_PAGE_POLL_MS; 
+ 	 	 
+ 	 	if(page_shown_ms >= STATISTICS_PAGE_DISPLAY_MS) 
+ 	 	{ 
+ 	 	 	page_shown_ms = 0; 
+ 	 	 	page = (page + 1) % NUMBER_OF_STATISTICS_PAGES; 
+ 	 	 	display_statistics_page(page, head, tail); 
+ 	 	} 
+ 	} 
+} 
+ 
+ 
+// Move the throughput window forward to the current system tick 
+// each completed bucket takes the belt running time since the previous one, and the oldest 
+// bucket is taken out of the running sums as its slot is reused 
+void update_throughput_window() 
+{ 
+ 	uint32_t now = read_tick_counter(&system_ticks); 
+ 	uint32_t belt_now = read_tick_counter(&belt_running_ticks); 
+ 	 
+ 	// after a gap longer than the whole window, every bucket is out of date 
+ 	if((now - throughput_bucket_start_tick) >= THROUGHPUT_WINDOW_TICKS) 
+ 	{ 
+ 	 	for(uint8_t i = 0; i < THROUGHPUT_WINDOW_BUCKETS; i++) 
+ 	 	{ 
+ 	 	 	throughput_buckets[i] = (throughput_bucket_t){ { 0 }, 0 }; 
+ 	 	} 
+ 	 	 
+ 	 	for(uint8_t m = 0; m < NUMBER_OF_MATERIALS; m++) 
+ 	 	{ 
+ 	 	 	window_items[m] = 0; 
+ 	 	} 
+ 	 	 
+ 	 	window_belt_running_ticks = 0; 
+ 	 	throughput_current_bucket = 0; 
+ 	 	throughput_completed_buckets = 0; 
+ 	 	throughput_bucket_start_tick = now; 
+ 	 	throughput_bucket_start_belt_tick = belt_now; 
+ 	 	return; 
+ 	} 
+ 	 
+ 	while((now - throughput_bucket_start_tick) >= THROUGHPUT_BUCKET_TICKS) 
+ 	{ 
+ 	 	throughput_bucket_t *bucket = &throughput_buckets[throughput_current_bucket]; 
+ 	 	bucket->belt_running_ticks = belt_now - throughput_bucket_start_belt_tick; 
+ 	 	window_belt_running_ticks += bucket->belt_running_ticks; 
+ 	 	throughput_bucket_start_belt_tick = belt_now; 
+ 	 	throughput_bucket_start_tick += THROUGHPUT_BUCKET_TICKS; 
+ 	 	 
+ 	 	if(throughput_completed_buckets < (THROUGHPUT_WINDOW_BUCKETS - 1)) 
+ 	 	{ 
+ 	 	 	throughput_completed_buckets++; 
+ 	 	} 
+ 	 	 
+ 	 	// the next slot holds the oldest bucket once the window is full, otherwise it is empty 
+ 	 	throughput_current_bucket = (throughput_current_bucket + 1) % THROUGHPUT_WINDOW_BUCKETS; 
+ 	 	bucket = &throughput_buckets[throughput_current_bucket]; 
+ 	 	 
+ 	 	for(uint8_t m = 0; m < NUMBER_OF_MATERIALS; m++) 
+ 	 	{ 
+ 	 	 	window_items[m] -= bucket->items[m]; 
+ 	 	 	bucket->items[m] = 0; 
+ 	 	} 
+ 	 	 
+ 	 	window_belt_running_ticks -= bucket->belt_running_ticks; 
+ 	 	bucket->belt_running_ticks = 0; 
+ 	} 
+} 
+ 
+ 
+// Add a sorted item to the current bucket of the throughput window 
+void record_item_in_throughput_window(item_type_t material) 
+{ 
+ 	if(material >= NUMBER_OF_MATERIALS) 
+ 	{ 
+ 	 	return; 
+ 	} 
+ 	 
+ 	update_throughput_window(); 
+ 	throughput_buckets[throughput_current_bucket].items[material]++; 
+ 	window_items[material]++; 
+} 
+ 
+ 
+// Get the time covered by the throughput window, the completed buckets plus the current one 
+uint32_t get_window_elapsed_ticks() 
+{ 
+ 	return ((uint32_t)throughput_completed_buckets * THROUGHPUT_BUCKET_TICKS) + 
+ 	 	(read_tick_counter(&system_ticks) - throughput_bucket_start_tick); 
+} 
+ 
+ 
+// Convert a number of items in the throughput window into items per minute 
+uint16_t get_items_per_minute(uint16_t items) 
+{ 
+ 	uint32_t elapsed_ticks = get_window_elapsed_ticks(); 
+ 	 
+ 	if(elapsed_ticks == 0) 
+ 	{ 
+ 	 	return 0; 
+ 	} 
+ 	 
+ 	return (uint16_t)(((uint32_t)items * MS_TO_SYSTEM_TICKS(MS_PER_MINUTE)) / elapsed_ticks); 
+} 
+ 
+ 
+// Get the items per minute of all four materials together 
+uint16_t get_total_items_per_minute() 
+{ 
+ 	return get_items_per_minute(window_items[ALUMINUM_ITEM] + window_items[STEEL_ITEM] + 
+ 	 	window_items[WHITE_ITEM] + window_items[BLACK_ITEM]); 
+} 
+ 
+ 
+// Get the share of the throughput window during which the conveyor belt was running 
+uint16_t get_belt_utilisation_percent() 
 { 
- 	clear_LCD_homescreen(); // clear previous display on LCD home screen  	ms_timer(10); 
- 	return_to_LCD_homescreen(); // return LCD cursor to the position (0, 0)   	ms_timer(10); 
+ 	uint32_t elapsed_ticks = get_window_elapsed_ticks(); 
+ 	uint32_t belt_ticks = window_belt_running_ticks + 
+ 	 	(read_tick_counter(&belt_running_ticks) - throughput_bucket_start_belt_tick); 
+ 	 
+ 	if(elapsed_ticks == 0) 
+ 	{ 
+ 	 	return 0; 
+ 	} 
+ 	 
+ 	return (uint16_t)((belt_ticks * 100UL) / elapsed_ticks); 
+} 
+ 
+ 
+// This function is reused in several places to display two strings on two lines 
+void write_lines_to_LCD(const char* line_1_string, const char* line_2_string) 
+{ 
+ 	BENCH_MARK_BEGIN(BENCH_LCD_WRITE_BIT); 
+ 	 
+ 	clear_LCD_homescreen(); // clear previous display on LCD home screen 
+ 	ms_timer(10); 
+ 	return_to_LCD_homescreen(); // return LCD cursor to the position (0, 0) 
+ 	ms_timer(10); 
  	 
  	// check if first line is not written 
  	// if it is, write a string to the first line on LCD  
@@ -596,6 +1094,44 @@ write_lines_to_LCD(const char* line_1_string, const char* line_2_string)
  	{ 
  	 	write_a_string_To_LCD_xy_position(0, 1, line_2_string); 
  	} 
+ 	 
+ 	BENCH_MARK_END(BENCH_LCD_WRITE_BIT); 
+} 
+ 
+ 
+// Display an unsigned 32-bit value on the LCD zero padded to the field width 
+// the int writer is only 16 bits wide, values too large for the field are capped at all nines 
+void write_a_uint32_value_To_LCD_xy_position(uint8_t x, uint8_t y, uint32_t value, uint8_t digits) 
+{ 
+ 	char value_string[11]; 
+ 	uint32_t field_limit = 1; 
+ 	 
+ 	// a 10-digit field holds any 32-bit value, so only narrower fields need capping 
+ 	if(digits >= 10) 
+ 	{ 
+ 	 	digits = 10; 
+ 	} 
+ 	else 
+ 	{ 
+ 	 	for(uint8_t i = 0; i < digits; i++) 
+ 	 	{ 
+ 	 	 	field_limit *= 10; 
+ 	 	} 
+ 	 	 
+ 	 	if(value >= field_limit) 
+ 	 	{ 
+ 	 	 	value = field_limit - 1; 
+ 	 	} 
+ 	} 
+ 	 
+ 	value_string[digits] = '\0'; 
+ 	for(int8_t i = digits - 1; i >= 0; i--) 
+ 	{ 
+ 	 	value_string[i] = '0' + (value % 10); 
+ 	 	value /= 10; 
+ 	} 
+ 	 
+ 	write_a_string_To_LCD_xy_position(x, y, value_string); 
 } 
  
  
@@ -673,6 +1209,21 @@ ISR(TIMER3_COMPA_vect)
  	ramp_down_flag = true; 
 }
  
+ 
+// Enable ISR for Timer 0 overflow to count the system ticks, and the ticks while the conveyor belt is running 
+// the system ticks keep counting while the system is paused, so a pause shows as idle time in the rates 
+// items only travel towards the EX sensor while the belt runs, so pauses and tray turns do not 
+// count against their arrival deadlines 
+ISR(TIMER0_OVF_vect) 
+{ 
+ 	system_ticks++; 
+ 	 
+ 	if(belt_is_running_flag == true) 
+ 	{ 
+ 	 	belt_running_ticks++; 
+ 	} 
+}
+ 
 // Enable BAD ISR to warn viewers that interrupt failed to trigger correctly 
 ISR(BADISR_vect)  
 { 
@@ -709,5 +1260,151 @@ void system_rampdown_delay_ms(uint16_t delay_amount)
  	TCCR3B |= ((1 << CS32) | (1 << CS30)); // divide clock IO by 1024 
  	OCR3A = delay_amount; // set timer 3 to stop counting at 600   
  	TCNT3 = 0x0000; // set timer 3 to count from 0 
- 	TIMSK3 |= 0x02; // set interrupt flag in the Status Register (global)  	TIFR3  |= (1 << OCF3A); 
+ 	TIMSK3 |= 0x02; // set interrupt flag in the Status Register (global) 
+ 	TIFR3  |= (1 << OCF3A); 
+}
+ 
+ 
+// Read a tick counter with interrupts held off, the 32-bit read is not atomic 
+uint32_t read_tick_counter(volatile uint32_t *tick_counter) 
+{ 
+ 	uint8_t sreg = SREG; 
+ 	cli(); 
+ 	uint32_t ticks = *tick_counter; 
+ 	SREG = sreg; 
+ 	 
+ 	return ticks; 
+} 
+ 
+ 
+// Get the OR to EX travel time in system ticks at the current belt speed 
+uint32_t get_item_travel_ticks() 
+{ 
+ 	uint16_t belt_speed = (DCmotor_current_speed != 0) ? DCmotor_current_speed : DCMOTOR_FIXED_SPEED; 
+ 	 
+ 	return MS_TO_SYSTEM_TICKS(((uint32_t)or_to_ex_travel_ms * DCMOTOR_FIXED_SPEED) / belt_speed); 
+} 
+ 
+ 
+// Record when an item enters the link list 
+// the entries follow the link list in order, the oldest one is at the head 
+void track_item_arrival_deadline() 
+{ 
+ 	if(item_deadline_count < MAX_TRACKED_ITEMS) 
+ 	{ 
+ 	 	uint8_t index = (item_deadline_head + item_deadline_count) & (MAX_TRACKED_ITEMS - 1); 
+ 	 	item_enqueue_tick[index] = read_tick_counter(&belt_running_ticks); 
+ 	 	item_deadline_count++; 
+ 	} 
 } 
+ 
+ 
+// Release the entry of the item that has just left the head of the link list 
+void release_item_arrival_deadline() 
+{ 
+ 	if(item_deadline_count > 0) 
+ 	{ 
+ 	 	item_deadline_head = (item_deadline_head + 1) & (MAX_TRACKED_ITEMS - 1); 
+ 	 	item_deadline_count--; 
+ 	} 
+} 
+ 
+ 
+// Check where the belt time stands against the arrival window of a tracked item, queue_position 0 
+// is the head of the link list, the window scales with the belt speed 
+// compare by difference so the check still works once the tick counter wraps 
+item_arrival_t get_item_arrival(uint8_t queue_position) 
+{ 
+ 	uint8_t index = (item_deadline_head + queue_position) & (MAX_TRACKED_ITEMS - 1); 
+ 	uint32_t travel_ticks = get_item_travel_ticks(); 
+ 	uint32_t earliest_arrival = item_enqueue_tick[index]; 
+ 	uint32_t latest_arrival = item_enqueue_tick[index]; 
+ 	uint32_t now = read_tick_counter(&belt_running_ticks); 
+ 	 
+ 	if(or_to_ex_travel_measured == true) 
+ 	{ 
+ 	 	earliest_arrival += (travel_ticks * ITEM_ARRIVAL_WINDOW_MIN_PERCENT) / 100; 
+ 	 	latest_arrival += (travel_ticks * ITEM_ARRIVAL_WINDOW_MAX_PERCENT) / 100; 
+ 	} 
+ 	else 
+ 	{ 
+ 	 	latest_arrival += (travel_ticks * ITEM_SEED_WINDOW_MAX_PERCENT) / 100; 
+ 	} 
+ 	 
+ 	if((int32_t)(now - earliest_arrival) < 0) 
+ 	{ 
+ 	 	return ITEM_ARRIVAL_TOO_EARLY; 
+ 	} 
+ 	 
+ 	if((int32_t)(now - latest_arrival) > 0) 
+ 	{ 
+ 	 	return ITEM_ARRIVAL_OVERDUE; 
+ 	} 
+ 	 
+ 	return ITEM_ARRIVAL_IN_WINDOW; 
+} 
+ 
+ 
+// Check if the item at the head of the link list should have reached the EX sensor by now 
+bool item_arrival_deadline_passed() 
+{ 
+ 	return ((item_deadline_count > 0) && (get_item_arrival(0) == ITEM_ARRIVAL_OVERDUE)); 
+} 
+ 
+ 
+// Take the item at the head of the link list off as missing and free the memory 
+void drop_missing_item(link **h, link **t) 
+{ 
+ 	link *missing_link; 
+ 	 
+ 	dequeue(h, t, &missing_link); 
+ 	release_item_arrival_deadline(); 
+ 	free(missing_link); 
+ 	number_of_missing_items++; 
+} 
+ 
+ 
+// Measure the travel time of the item that has just reached the EX sensor and fold it into the 
+// running average, scaled back to DCMOTOR_FIXED_SPEED 
+// only an item that arrived inside its window is measured, an overdue head may belong to another item 
+void record_item_travel_time() 
+{ 
+ 	if((item_deadline_count == 0) || (get_item_arrival(0) != ITEM_ARRIVAL_IN_WINDOW)) 
+ 	{ 
+ 	 	return; 
+ 	} 
+ 	 
+ 	uint16_t belt_speed = (DCmotor_current_speed != 0) ? DCmotor_current_speed : DCMOTOR_FIXED_SPEED; 
+ 	uint32_t travel_ticks = read_tick_counter(&belt_running_ticks) - item_enqueue_tick[item_deadline_head]; 
+ 	uint32_t travel_ms = (((travel_ticks * SYSTEM_TICK_US) / 1000UL) * belt_speed) / DCMOTOR_FIXED_SPEED; 
+ 	 
+ 	if(travel_ms > 0xFFFF) 
+ 	{ 
+ 	 	travel_ms = 0xFFFF; 
+ 	} 
+ 	 
+ 	if(or_to_ex_travel_measured == false) 
+ 	{ 
+ 	 	or_to_ex_travel_ms = travel_ms; 
+ 	 	or_to_ex_travel_measured = true; 
+ 	} 
+ 	else 
+ 	{ 
+ 	 	or_to_ex_travel_ms = (int32_t)or_to_ex_travel_ms + 
+ 	 	 	(((int32_t)travel_ms - (int32_t)or_to_ex_travel_ms) / TRAVEL_AVERAGE_WEIGHT); 
+ 	} 
+} 
+ 
+ 
+#ifdef BENCHMARK 
+// Tell simavr which MCU and clock to simulate and which pins to trace for viewing 
+// the sensors are traced as pins so their edges show when they happen, not when PIND is read 
+AVR_MCU(8000000, "atmega2560"); 
+AVR_MCU_VCD_FILE("bench_trace.vcd", 1000); 
+AVR_MCU_VCD_PORT_PIN('D', 1, "HALL_SENSOR"); 
+AVR_MCU_VCD_PORT_PIN('D', 2, "OR_SENSOR"); 
+AVR_MCU_VCD_PORT_PIN('D', 3, "EX_SENSOR"); 
+AVR_MCU_VCD_PORT_PIN('L', 0, "LCD_WRITE"); 
+AVR_MCU_VCD_PORT_PIN('L', 1, "STEPPER_STEP"); 
+AVR_MCU_VCD_PORT_PIN('L', 2, "ITEM_SORTED"); 
+#endif
\ No newline at end of file